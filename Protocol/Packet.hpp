@@ -44,6 +44,13 @@ namespace Protocol
     using EnableIfContainerDetected = std::enable_if_t<Core::Utils::IsDetected<ContainerDetector, Type>>;
     template<typename Type>
     using EnableIfContainerNotDetected = std::enable_if_t<!Core::Utils::IsDetected<ContainerDetector, Type>>;
+
+    /** @brief A contiguous part of a scattered packet (same layout intent as an iovec) */
+    struct PacketSegment
+    {
+        const std::uint8_t *data { nullptr };
+        std::size_t size { 0u };
+    };
 }
 
 /** @brief Base of any packet */
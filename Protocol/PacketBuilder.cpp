@@ -0,0 +1,127 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Packet builder
+ */
+
+#include <algorithm>
+
+#include "PacketBuilder.hpp"
+
+using namespace Protocol;
+
+PacketChunkPool::~PacketChunkPool(void) noexcept
+{
+    while (_free) {
+        auto *next = _free->next;
+        delete _free;
+        _free = next;
+    }
+}
+
+PacketChunkPool::Chunk *PacketChunkPool::acquire(void)
+{
+    if (!_free)
+        return new Chunk;
+    auto *chunk = _free;
+    _free = chunk->next;
+    --_freeCount;
+    chunk->next = nullptr;
+    chunk->size = 0u;
+    return chunk;
+}
+
+void PacketChunkPool::release(Chunk *chain) noexcept
+{
+    while (chain) {
+        auto *next = chain->next;
+        chain->next = _free;
+        _free = chain;
+        ++_freeCount;
+        chain = next;
+    }
+}
+
+PacketBuilder::PacketBuilder(PacketBuilder &&other) noexcept
+    : _pool(other._pool), _head(other._head), _tail(other._tail), _header(other._header)
+{
+    other._head = nullptr;
+    other._tail = nullptr;
+}
+
+PacketBuilder &PacketBuilder::operator=(PacketBuilder &&other) noexcept
+{
+    clear();
+    _pool = other._pool;
+    _head = other._head;
+    _tail = other._tail;
+    _header = other._header;
+    other._head = nullptr;
+    other._tail = nullptr;
+    return *this;
+}
+
+void PacketBuilder::pushFootprint(const BoardID boardID)
+{
+    write(&boardID, sizeof(BoardID));
+    _header.footprintStackSize++;
+}
+
+std::size_t PacketBuilder::chunkCount(void) const noexcept
+{
+    std::size_t count = 0u;
+
+    for (auto *chunk = _head; chunk; chunk = chunk->next)
+        ++count;
+    return count;
+}
+
+void PacketBuilder::clear(void) noexcept
+{
+    if (_head)
+        _pool->release(_head);
+    _head = nullptr;
+    _tail = nullptr;
+    _header = Header {};
+}
+
+void PacketBuilder::write(const void * const data, const std::size_t size)
+{
+    if (!_tail)
+        throw std::logic_error("Protocol::PacketBuilder::write: Packet is not prepared");
+    else if (_header.payload + size > PayloadMax)
+        throw std::runtime_error("Protocol::PacketBuilder::write: Payload overflow");
+    // Acquire every missing chunk before writing so that a failing allocation leaves the packet untouched
+    const std::size_t available = PacketChunkPool::ChunkCapacity - _tail->size;
+    if (size > available) {
+        const auto missing = (size - available + PacketChunkPool::ChunkCapacity - 1) / PacketChunkPool::ChunkCapacity;
+        Chunk *chain = nullptr;
+        try {
+            for (auto i = 0u; i < missing; ++i) {
+                auto *chunk = _pool->acquire();
+                chunk->next = chain;
+                chain = chunk;
+            }
+        } catch (...) {
+            _pool->release(chain);
+            throw;
+        }
+        _tail->next = chain;
+    }
+    auto *input = reinterpret_cast<const std::uint8_t *>(data);
+    auto remaining = size;
+    while (remaining) {
+        if (_tail->size == PacketChunkPool::ChunkCapacity)
+            _tail = _tail->next;
+        const auto count = std::min(remaining, PacketChunkPool::ChunkCapacity - _tail->size);
+        std::memcpy(_tail->data + _tail->size, input, count);
+        _tail->size = static_cast<std::uint16_t>(_tail->size + count);
+        input += count;
+        remaining -= count;
+    }
+    _header.payload = static_cast<Payload>(_header.payload + size);
+}
+
+void PacketBuilder::fixupHeader(void) noexcept
+{
+    std::memcpy(_head->data, &_header, sizeof(Header));
+}
@@ -0,0 +1,184 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Packet builder
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Packet.hpp"
+
+namespace Protocol
+{
+    class PacketChunkPool;
+    class PacketBuilder;
+
+    namespace Internal
+    {
+        /** @brief Check if an iterator type points to contiguous memory */
+        template<typename Iterator, typename Type = typename std::iterator_traits<Iterator>::value_type>
+        constexpr bool IsContiguousIterator =
+            std::is_pointer_v<Iterator> ||
+            (!std::is_same_v<Type, bool> && (
+                std::is_same_v<Iterator, typename std::vector<Type>::iterator> ||
+                std::is_same_v<Iterator, typename std::vector<Type>::const_iterator>
+            ));
+
+        template<typename Iterator>
+        constexpr bool IsContiguousIterator<Iterator, char> =
+            std::is_pointer_v<Iterator> ||
+            std::is_same_v<Iterator, std::vector<char>::iterator> ||
+            std::is_same_v<Iterator, std::vector<char>::const_iterator> ||
+            std::is_same_v<Iterator, std::string::iterator> ||
+            std::is_same_v<Iterator, std::string::const_iterator>;
+
+        /** @brief Check if iterator type is eligible to a fast bulk copy */
+        template<typename Iterator>
+        constexpr bool IsTriviallyBulkCopyable =
+            std::is_trivially_copyable_v<std::remove_reference_t<decltype(*std::declval<Iterator>())>> &&
+            IsContiguousIterator<Iterator>;
+    }
+}
+
+/** @brief A pool of fixed-size chunks recycled by packet builders */
+class alignas_quarter_cacheline Protocol::PacketChunkPool
+{
+public:
+    /** @brief Usable bytes of a single chunk */
+    static constexpr std::size_t ChunkCapacity = 240u;
+
+    /** @brief A single chunk of a builder chain */
+    struct alignas(alignof(Internal::PacketBase::Header)) Chunk
+    {
+        std::uint8_t data[ChunkCapacity];
+        Chunk *next { nullptr };
+        std::uint16_t size { 0u };
+    };
+
+    static_assert(sizeof(Internal::PacketBase::Header) <= ChunkCapacity, "Protocol::PacketChunkPool: A chunk must fit a packet header");
+
+    /** @brief Default constructor */
+    PacketChunkPool(void) noexcept = default;
+
+    /** @brief A pool is not copyable nor movable as builders keep a reference on it */
+    PacketChunkPool(const PacketChunkPool &other) = delete;
+    PacketChunkPool &operator=(const PacketChunkPool &other) = delete;
+
+    /** @brief Destructor, free every cached chunk */
+    ~PacketChunkPool(void) noexcept;
+
+
+    /** @brief Get an empty chunk from the pool, allocate one if none is cached */
+    [[nodiscard]] Chunk *acquire(void);
+
+    /** @brief Give back a chain of chunks to the pool */
+    void release(Chunk *chain) noexcept;
+
+    /** @brief Get the number of cached chunks */
+    [[nodiscard]] std::size_t freeCount(void) const noexcept { return _freeCount; }
+
+private:
+    Chunk *_free { nullptr };
+    std::size_t _freeCount { 0u };
+};
+
+static_assert_fit_quarter_cacheline(Protocol::PacketChunkPool);
+
+/** @brief A write-only packet that grows on demand over a chain of pooled chunks */
+class alignas_cacheline Protocol::PacketBuilder
+{
+public:
+    using Header = Internal::PacketBase::Header;
+    using Chunk = PacketChunkPool::Chunk;
+    using Segment = PacketSegment;
+
+    /** @brief Payload maximum value, the header is counted in the packet size range like in WritablePacket */
+    static constexpr Payload PayloadMax = static_cast<Payload>(Internal::PacketBase::PayloadMax - sizeof(Header));
+
+    /** @brief Construct a builder drawing its chunks from a pool */
+    PacketBuilder(PacketChunkPool &pool) noexcept : _pool(&pool) {}
+
+    /** @brief Move constructor */
+    PacketBuilder(PacketBuilder &&other) noexcept;
+
+    /** @brief Destructor, give back chunks to the pool */
+    ~PacketBuilder(void) noexcept { clear(); }
+
+    /** @brief Move assignment */
+    PacketBuilder &operator=(PacketBuilder &&other) noexcept;
+
+
+    /** @brief Prepare a packet */
+    template<typename CommandType, std::enable_if_t<sizeof(CommandType) == sizeof(Command)>* = nullptr>
+    PacketBuilder &prepare(const ProtocolType protocolType, const CommandType command);
+
+    /** @brief Insert a range of values in the packet */
+    template<typename InputIterator>
+    PacketBuilder &insert(const InputIterator begin, const InputIterator end);
+
+    /** @brief Insert the serializable data of a container to the packet */
+    template<typename Container, EnableIfContainerDetected<Container>* = nullptr>
+    PacketBuilder &operator<<(const Container &container);
+
+    /** @brief Insert trivially serializable data to the packet */
+    template<typename Type, EnableIfContainerNotDetected<Type>* = nullptr>
+    PacketBuilder &operator<<(const Type &value);
+
+    /** @brief push a boardID at the end of the footprint stack */
+    void pushFootprint(const BoardID boardID);
+
+
+    /** @brief Get the packet payload (data size without header) */
+    [[nodiscard]] Payload payload(void) const noexcept { return _header.payload; }
+
+    /** @brief Get the total packet size (header and data) */
+    [[nodiscard]] Payload totalSize(void) const noexcept { return static_cast<Payload>(payload() + sizeof(Header)); }
+
+    /** @brief Get the protocol type (Connection / Event) */
+    [[nodiscard]] ProtocolType protocolType(void) const noexcept { return _header.protocolType; }
+
+    /** @brief Get the packet opaque command */
+    [[nodiscard]] Command command(void) const noexcept { return _header.command; }
+
+    /** @brief Get the command casted to a specific type */
+    template<typename CommandType>
+    [[nodiscard]] CommandType commandAs(void) const noexcept { return static_cast<CommandType>(command()); }
+
+    /** @brief Get the packet footprint stack size */
+    [[nodiscard]] std::uint16_t footprintStackSize(void) const noexcept { return _header.footprintStackSize; }
+
+    /** @brief Get the number of chunks used by the packet */
+    [[nodiscard]] std::size_t chunkCount(void) const noexcept;
+
+
+    /** @brief Copy the whole packet into a contiguous buffer and return its total size
+     *  The buffer must be at least 'totalSize()' bytes long */
+    template<typename BinaryData>
+    std::size_t finalize(BinaryData * const begin, BinaryData * const end);
+
+    /** @brief Write one segment per chunk into 'out' and return the iterator past the last one
+     *  Segments point into the builder and remain valid until its next modification */
+    template<typename OutputIterator>
+    OutputIterator finalizeSegments(OutputIterator out);
+
+    /** @brief Give back every chunk to the pool */
+    void clear(void) noexcept;
+
+private:
+    PacketChunkPool *_pool { nullptr };
+    Chunk *_head { nullptr };
+    Chunk *_tail { nullptr };
+    Header _header {};
+
+    /** @brief Append raw bytes, growing the chunk chain when needed */
+    void write(const void * const data, const std::size_t size);
+
+    /** @brief Write the header at the front of the first chunk */
+    void fixupHeader(void) noexcept;
+};
+
+static_assert_fit_cacheline(Protocol::PacketBuilder);
+
+#include "PacketBuilder.ipp"
@@ -0,0 +1,91 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Packet builder
+ */
+
+#include <stdexcept>
+
+template<typename CommandType, std::enable_if_t<sizeof(CommandType) == sizeof(Protocol::Command)>*>
+inline Protocol::PacketBuilder &Protocol::PacketBuilder::prepare(const ProtocolType protocolType, const CommandType command)
+{
+    if (!_head)
+        _head = _pool->acquire();
+    else if (_head->next) {
+        _pool->release(_head->next);
+        _head->next = nullptr;
+    }
+    // Reserve the header room, it is written on finalization
+    _head->size = static_cast<std::uint16_t>(sizeof(Header));
+    _tail = _head;
+    _header = Header {};
+    _header.protocolType = protocolType;
+    _header.command = static_cast<Command>(command);
+    return *this;
+}
+
+template<typename InputIterator>
+inline Protocol::PacketBuilder &Protocol::PacketBuilder::insert(const InputIterator begin, const InputIterator end)
+{
+    using Type = std::remove_reference_t<decltype(*std::declval<InputIterator>())>;
+
+    // Check if the container contains optimizable trivially copyable types
+    if constexpr (Internal::IsTriviallyBulkCopyable<InputIterator>) {
+        const auto size = static_cast<std::size_t>(std::distance(begin, end));
+        if (size)
+            write(&*begin, size * sizeof(Type));
+    } else {
+        for (auto it = begin; it < end; ++it)
+            *this << *it;
+    }
+    return *this;
+}
+
+template<typename Container, Protocol::EnableIfContainerDetected<Container>*>
+inline Protocol::PacketBuilder &Protocol::PacketBuilder::operator<<(const Container &container)
+{
+    const auto begin = std::begin(container);
+    const auto end = std::end(container);
+
+    *this << static_cast<Payload>(std::distance(begin, end));
+    return insert(begin, end);
+}
+
+template<typename Type, Protocol::EnableIfContainerNotDetected<Type>*>
+inline Protocol::PacketBuilder &Protocol::PacketBuilder::operator<<(const Type &value)
+{
+    static_assert(std::is_trivially_copyable_v<Type>, "Protocol::PacketBuilder::operator<<: Type must be trivially copyable");
+
+    write(&value, sizeof(Type));
+    return *this;
+}
+
+template<typename BinaryData>
+inline std::size_t Protocol::PacketBuilder::finalize(BinaryData * const begin, BinaryData * const end)
+{
+    const auto size = totalSize();
+
+    if (!_head)
+        throw std::logic_error("Protocol::PacketBuilder::finalize: Packet is not prepared");
+    else if (static_cast<std::size_t>(std::distance(begin, end)) * sizeof(BinaryData) < size)
+        throw std::runtime_error("Protocol::PacketBuilder::finalize: Output buffer too small");
+    fixupHeader();
+    auto *out = reinterpret_cast<std::uint8_t *>(begin);
+    for (auto *chunk = _head; chunk; chunk = chunk->next) {
+        std::memcpy(out, chunk->data, chunk->size);
+        out += chunk->size;
+    }
+    return size;
+}
+
+template<typename OutputIterator>
+inline OutputIterator Protocol::PacketBuilder::finalizeSegments(OutputIterator out)
+{
+    if (!_head)
+        throw std::logic_error("Protocol::PacketBuilder::finalizeSegments: Packet is not prepared");
+    fixupHeader();
+    for (auto *chunk = _head; chunk; chunk = chunk->next) {
+        *out = Segment { chunk->data, chunk->size };
+        ++out;
+    }
+    return out;
+}
@@ -11,6 +11,12 @@ set(ProtocolSources
     ${ProtocolDir}/Packet.hpp
     ${ProtocolDir}/Packet.ipp
     ${ProtocolDir}/Packet.cpp
+    ${ProtocolDir}/PacketBuilder.hpp
+    ${ProtocolDir}/PacketBuilder.ipp
+    ${ProtocolDir}/PacketBuilder.cpp
+    ${ProtocolDir}/SharedPacket.hpp
+    ${ProtocolDir}/SharedPacket.ipp
+    ${ProtocolDir}/SharedPacket.cpp
     ${ProtocolDir}/NetworkLog.hpp
 )
 
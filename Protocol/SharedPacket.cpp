@@ -0,0 +1,193 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Shared packet
+ */
+
+#include <algorithm>
+#include <new>
+
+#include "SharedPacket.hpp"
+
+using namespace Protocol;
+
+SharedPacketBuffer::SharedPacketBuffer(PacketBuilder &builder)
+{
+    if (!builder.chunkCount())
+        throw std::logic_error("Protocol::SharedPacketBuffer::SharedPacketBuffer: Packet builder is not prepared");
+    const auto size = builder.totalSize();
+    allocate(size);
+    auto *data = reinterpret_cast<std::uint8_t *>(_storage + 1);
+    builder.finalize(data, data + size);
+}
+
+SharedPacketBuffer &SharedPacketBuffer::operator=(const SharedPacketBuffer &other) noexcept
+{
+    if (_storage != other._storage) {
+        release();
+        _storage = other._storage;
+        acquire();
+    }
+    return *this;
+}
+
+SharedPacketBuffer &SharedPacketBuffer::operator=(SharedPacketBuffer &&other) noexcept
+{
+    if (this != &other) {
+        release();
+        _storage = other._storage;
+        other._storage = nullptr;
+    }
+    return *this;
+}
+
+void SharedPacketBuffer::allocate(const std::size_t size)
+{
+    _storage = new (::operator new(sizeof(Storage) + size)) Storage;
+    _storage->size = static_cast<std::uint32_t>(size);
+}
+
+void SharedPacketBuffer::checkIntegrity(void)
+{
+    const auto &packetHeader = header();
+
+    if (packetHeader.payload > PacketBuilder::PayloadMax || _storage->size < packetHeader.payload + sizeof(Header)
+            || packetHeader.footprintStackSize > packetHeader.payload) {
+        release();
+        throw std::logic_error("Protocol::SharedPacketBuffer::checkIntegrity: Packet header doesn't match its data size");
+    }
+}
+
+void SharedPacketBuffer::acquire(void) noexcept
+{
+    if (_storage)
+        _storage->refCount.fetch_add(1u, std::memory_order_relaxed);
+}
+
+void SharedPacketBuffer::release(void) noexcept
+{
+    if (!_storage)
+        return;
+    if (_storage->refCount.fetch_sub(1u, std::memory_order_acq_rel) == 1u) {
+        _storage->~Storage();
+        ::operator delete(_storage);
+    }
+    _storage = nullptr;
+}
+
+SharedPacket::SharedPacket(const SharedPacketBuffer &buffer)
+    : _buffer(buffer)
+{
+    if (!_buffer.useCount())
+        throw std::logic_error("Protocol::SharedPacket::SharedPacket: Shared buffer is empty");
+    _header = _buffer.header();
+    const auto footprintStackSize = _header.footprintStackSize;
+
+    reserveFootprint(footprintStackSize, 0u);
+    std::memcpy(footprintStack(), buffer.rawDataBegin() + sizeof(Header) + buffer.bodySize(), footprintStackSize);
+}
+
+SharedPacket::SharedPacket(const SharedPacket &other)
+    : _buffer(other._buffer), _header(other._header)
+{
+    reserveFootprint(_header.footprintStackSize, 0u);
+    std::memcpy(footprintStack(), other.footprintStackBegin(), _header.footprintStackSize);
+}
+
+SharedPacket::SharedPacket(SharedPacket &&other) noexcept
+    : _buffer(std::move(other._buffer)), _header(other._header)
+{
+    stealFootprint(other);
+}
+
+SharedPacket &SharedPacket::operator=(const SharedPacket &other)
+{
+    if (this != &other) {
+        reserveFootprint(other._header.footprintStackSize, 0u);
+        std::memcpy(footprintStack(), other.footprintStackBegin(), other._header.footprintStackSize);
+        _buffer = other._buffer;
+        _header = other._header;
+    }
+    return *this;
+}
+
+SharedPacket &SharedPacket::operator=(SharedPacket &&other) noexcept
+{
+    if (this != &other) {
+        releaseFootprint();
+        _buffer = std::move(other._buffer);
+        _header = other._header;
+        stealFootprint(other);
+    }
+    return *this;
+}
+
+void SharedPacket::pushFootprint(const BoardID boardID)
+{
+    if (_header.payload >= PacketBuilder::PayloadMax)
+        throw std::runtime_error("Protocol::SharedPacket::pushFootprint: Payload overflow");
+    if (_header.footprintStackSize == _footprintCapacity)
+        reserveFootprint(_header.footprintStackSize + 1u, _header.footprintStackSize);
+    footprintStack()[_header.footprintStackSize] = boardID;
+    _header.payload++;
+    _header.footprintStackSize++;
+}
+
+BoardID SharedPacket::popFrontStack(void) noexcept
+{
+    if (_header.footprintStackSize == 0)
+        return 0;
+    auto *stack = footprintStack();
+    const BoardID first = stack[0];
+    _header.payload--;
+    _header.footprintStackSize--;
+    std::memmove(stack, stack + 1, _header.footprintStackSize);
+    stack[_header.footprintStackSize] = 0u;
+    return first;
+}
+
+BoardID SharedPacket::popBackStack(void) noexcept
+{
+    if (_header.footprintStackSize == 0)
+        return 0;
+    auto *stack = footprintStack();
+    _header.payload--;
+    _header.footprintStackSize--;
+    const BoardID last = stack[_header.footprintStackSize];
+    stack[_header.footprintStackSize] = 0u;
+    return last;
+}
+
+void SharedPacket::reserveFootprint(const std::size_t capacity, const std::size_t preserved)
+{
+    constexpr std::size_t MaxCapacity = std::numeric_limits<std::uint16_t>::max();
+
+    if (capacity <= _footprintCapacity)
+        return;
+    const auto newCapacity = std::min(std::max(capacity, static_cast<std::size_t>(_footprintCapacity) * 2u), MaxCapacity);
+    auto *heap = new BoardID[newCapacity] {};
+    std::memcpy(heap, footprintStackBegin(), preserved);
+    releaseFootprint();
+    _heapFootprint = heap;
+    _footprintCapacity = static_cast<std::uint16_t>(newCapacity);
+}
+
+void SharedPacket::releaseFootprint(void) noexcept
+{
+    if (isFootprintInline())
+        return;
+    delete[] _heapFootprint;
+    _footprintCapacity = InlineFootprintCapacity;
+}
+
+void SharedPacket::stealFootprint(SharedPacket &other) noexcept
+{
+    if (other.isFootprintInline())
+        std::memcpy(_inlineFootprint, other._inlineFootprint, InlineFootprintCapacity);
+    else {
+        _heapFootprint = other._heapFootprint;
+        _footprintCapacity = other._footprintCapacity;
+        other._footprintCapacity = InlineFootprintCapacity;
+    }
+    other._header.payload = static_cast<Payload>(other._header.payload - other._header.footprintStackSize);
+    other._header.footprintStackSize = 0u;
+}
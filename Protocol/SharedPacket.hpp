@@ -0,0 +1,203 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Shared packet
+ */
+
+#pragma once
+
+#include <atomic>
+
+#include "PacketBuilder.hpp"
+
+namespace Protocol
+{
+    class SharedPacketBuffer;
+    class SharedPacket;
+}
+
+/** @brief An immutable reference-counted packet, built once and shared by many destinations */
+class alignas_eighth_cacheline Protocol::SharedPacketBuffer
+{
+public:
+    using Header = Internal::PacketBase::Header;
+
+    /** @brief Construct a shared buffer by copying a raw packet once */
+    template<typename BinaryData>
+    SharedPacketBuffer(const BinaryData * const begin, const BinaryData * const end);
+
+    /** @brief Construct a shared buffer by gathering the chunks of a builder once */
+    explicit SharedPacketBuffer(PacketBuilder &builder);
+
+    /** @brief Copy constructor, share the same buffer */
+    SharedPacketBuffer(const SharedPacketBuffer &other) noexcept : _storage(other._storage) { acquire(); }
+
+    /** @brief Move constructor */
+    SharedPacketBuffer(SharedPacketBuffer &&other) noexcept : _storage(other._storage) { other._storage = nullptr; }
+
+    /** @brief Destructor, free the buffer if it is the last reference */
+    ~SharedPacketBuffer(void) noexcept { release(); }
+
+    /** @brief Copy assignment */
+    SharedPacketBuffer &operator=(const SharedPacketBuffer &other) noexcept;
+
+    /** @brief Move assignment */
+    SharedPacketBuffer &operator=(SharedPacketBuffer &&other) noexcept;
+
+
+    /** @brief Get the number of handles sharing the buffer */
+    [[nodiscard]] std::uint32_t useCount(void) const noexcept
+        { return _storage ? _storage->refCount.load(std::memory_order_relaxed) : 0u; }
+
+    /** @brief Get the original packet header */
+    [[nodiscard]] const Header &header(void) const noexcept { return *reinterpret_cast<const Header *>(rawDataBegin()); }
+
+    /** @brief Get the size of the data shared by every destination (payload without footprint stack) */
+    [[nodiscard]] Payload bodySize(void) const noexcept
+        { return static_cast<Payload>(header().payload - header().footprintStackSize); }
+
+    /** @brief Raw data begin / end */
+    [[nodiscard]] const std::uint8_t *rawDataBegin(void) const noexcept { return reinterpret_cast<const std::uint8_t *>(_storage + 1); }
+    [[nodiscard]] const std::uint8_t *rawDataEnd(void) const noexcept { return rawDataBegin() + _storage->size; }
+
+    /** @brief Get a read-only view of the original packet, without copy */
+    [[nodiscard]] ReadablePacket view(void) const noexcept_ndebug { return ReadablePacket(rawDataBegin(), rawDataEnd()); }
+
+private:
+    /** @brief Allocation prefix, followed by the raw packet bytes */
+    struct alignas(8) Storage
+    {
+        std::atomic<std::uint32_t> refCount { 1u };
+        std::uint32_t size { 0u };
+    };
+
+    Storage *_storage { nullptr };
+
+    /** @brief Allocate an uninitialized storage able to hold 'size' bytes */
+    void allocate(const std::size_t size);
+
+    /** @brief Check that the raw packet is consistent with its header */
+    void checkIntegrity(void);
+
+    /** @brief Increment / decrement the reference count */
+    void acquire(void) noexcept;
+    void release(void) noexcept;
+};
+
+static_assert_fit_eighth_cacheline(Protocol::SharedPacketBuffer);
+
+/** @brief A per-destination packet that overlays its own header and footprint stack on a shared buffer */
+class alignas_half_cacheline Protocol::SharedPacket
+{
+public:
+    using Header = Internal::PacketBase::Header;
+
+    /** @brief Footprint stack size held inline by a destination, deeper stacks fall back to the heap */
+    static constexpr std::uint16_t InlineFootprintCapacity = 8u;
+
+    /** @brief Construct a destination packet from a shared buffer, copying only its header and footprint stack */
+    explicit SharedPacket(const SharedPacketBuffer &buffer);
+
+    /** @brief Copy constructor */
+    SharedPacket(const SharedPacket &other);
+
+    /** @brief Move constructor */
+    SharedPacket(SharedPacket &&other) noexcept;
+
+    /** @brief Destructor */
+    ~SharedPacket(void) noexcept { releaseFootprint(); }
+
+    /** @brief Copy assignment */
+    SharedPacket &operator=(const SharedPacket &other);
+
+    /** @brief Move assignment */
+    SharedPacket &operator=(SharedPacket &&other) noexcept;
+
+
+    /** @brief Get the header's magic key */
+    [[nodiscard]] MagicKey magicKey(void) const noexcept { return _header.magicKey; }
+
+    /** @brief Get the packet payload (data size without header) */
+    [[nodiscard]] Payload payload(void) const noexcept { return _header.payload; }
+
+    /** @brief Get the total packet size (header and data) */
+    [[nodiscard]] Payload totalSize(void) const noexcept { return static_cast<Payload>(payload() + sizeof(Header)); }
+
+    /** @brief Get the protocol type (Connection / Event) */
+    [[nodiscard]] ProtocolType protocolType(void) const noexcept { return _header.protocolType; }
+
+    /** @brief Get the packet opaque command */
+    [[nodiscard]] Command command(void) const noexcept { return _header.command; }
+
+    /** @brief Get the command casted to a specific type */
+    template<typename CommandType>
+    [[nodiscard]] CommandType commandAs(void) const noexcept { return static_cast<CommandType>(command()); }
+
+    /** @brief Get the packet footprint stack size */
+    [[nodiscard]] std::uint16_t footprintStackSize(void) const noexcept { return _header.footprintStackSize; }
+
+    /** @brief Get the begining / end of footprint stack pointer */
+    [[nodiscard]] const BoardID *footprintStackBegin(void) const noexcept
+        { return isFootprintInline() ? _inlineFootprint : _heapFootprint; }
+    [[nodiscard]] const BoardID *footprintStackEnd(void) const noexcept { return footprintStackBegin() + _header.footprintStackSize; }
+
+    /** @brief Get the shared data pointer (payload without footprint stack) */
+    template<typename Type = std::uint8_t>
+    [[nodiscard]] const Type *data(void) const noexcept
+        { return reinterpret_cast<const Type *>(_buffer.rawDataBegin() + sizeof(Header)); }
+
+    /** @brief Get the shared data size */
+    [[nodiscard]] Payload bodySize(void) const noexcept { return _buffer.bodySize(); }
+
+    /** @brief Get the underlying shared buffer */
+    [[nodiscard]] const SharedPacketBuffer &buffer(void) const noexcept { return _buffer; }
+
+
+    /** @brief push a boardID at the end of the footprint stack */
+    void pushFootprint(const BoardID boardID);
+
+    /** @brief remove the boardID at the front of the footprint stack and return the value */
+    BoardID popFrontStack(void) noexcept;
+
+    /** @brief remove the boardID at the end of the footprint stack and return the value */
+    BoardID popBackStack(void) noexcept;
+
+
+    /** @brief Write the header, shared data and footprint stack segments into 'out' and return the iterator past the last one
+     *  The header and footprint stack segments point into this handle: it must not be modified, moved nor destroyed while they are in use */
+    template<typename OutputIterator>
+    OutputIterator segments(OutputIterator out) const;
+
+    /** @brief Copy the whole packet into a contiguous buffer and return its total size
+     *  The buffer must be at least 'totalSize()' bytes long */
+    template<typename BinaryData>
+    std::size_t finalize(BinaryData * const begin, BinaryData * const end) const;
+
+private:
+    SharedPacketBuffer _buffer;
+    union {
+        BoardID _inlineFootprint[InlineFootprintCapacity] {};
+        BoardID *_heapFootprint;
+    };
+    Header _header {};
+    std::uint16_t _footprintCapacity { InlineFootprintCapacity };
+
+    /** @brief Check if the footprint stack is stored inline */
+    [[nodiscard]] bool isFootprintInline(void) const noexcept { return _footprintCapacity == InlineFootprintCapacity; }
+
+    /** @brief Get the mutable footprint stack pointer */
+    [[nodiscard]] BoardID *footprintStack(void) noexcept { return const_cast<BoardID *>(footprintStackBegin()); }
+
+    /** @brief Ensure the footprint stack can hold 'capacity' boards, moving it to the heap if needed
+     *  Only the first 'preserved' boards are kept */
+    void reserveFootprint(const std::size_t capacity, const std::size_t preserved);
+
+    /** @brief Free the heap footprint stack if any and go back to the inline one */
+    void releaseFootprint(void) noexcept;
+
+    /** @brief Steal the footprint stack of another packet, which is left empty */
+    void stealFootprint(SharedPacket &other) noexcept;
+};
+
+static_assert_fit_half_cacheline(Protocol::SharedPacket);
+
+#include "SharedPacket.ipp"
@@ -0,0 +1,50 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Shared packet
+ */
+
+#include <stdexcept>
+
+template<typename BinaryData>
+inline Protocol::SharedPacketBuffer::SharedPacketBuffer(const BinaryData * const begin, const BinaryData * const end)
+{
+    const auto size = static_cast<std::size_t>(std::distance(begin, end)) * sizeof(BinaryData);
+
+    if (size < sizeof(Header))
+        throw std::logic_error("Protocol::SharedPacketBuffer::SharedPacketBuffer: Invalid packet data size must be equal or greater than header size");
+    allocate(size);
+    std::memcpy(reinterpret_cast<std::uint8_t *>(_storage + 1), begin, size);
+    checkIntegrity();
+}
+
+template<typename OutputIterator>
+inline OutputIterator Protocol::SharedPacket::segments(OutputIterator out) const
+{
+    *out = PacketSegment { reinterpret_cast<const std::uint8_t *>(&_header), sizeof(Header) };
+    ++out;
+    if (const auto size = bodySize(); size) {
+        *out = PacketSegment { data(), size };
+        ++out;
+    }
+    if (const auto size = footprintStackSize(); size) {
+        *out = PacketSegment { footprintStackBegin(), size };
+        ++out;
+    }
+    return out;
+}
+
+template<typename BinaryData>
+inline std::size_t Protocol::SharedPacket::finalize(BinaryData * const begin, BinaryData * const end) const
+{
+    const auto size = sizeof(Header) + static_cast<std::size_t>(payload());
+
+    if (static_cast<std::size_t>(std::distance(begin, end)) * sizeof(BinaryData) < size)
+        throw std::runtime_error("Protocol::SharedPacket::finalize: Output buffer too small");
+    auto *out = reinterpret_cast<std::uint8_t *>(begin);
+    std::memcpy(out, &_header, sizeof(Header));
+    out += sizeof(Header);
+    std::memcpy(out, data(), bodySize());
+    out += bodySize();
+    std::memcpy(out, footprintStackBegin(), footprintStackSize());
+    return size;
+}
@@ -6,6 +6,8 @@ get_filename_component(ProtocolTestsDir ${CMAKE_CURRENT_LIST_FILE} PATH)
 
 set(ProtocolTestsSources
     ${ProtocolTestsDir}/tests_Packet.cpp
+    ${ProtocolTestsDir}/tests_PacketBuilder.cpp
+    ${ProtocolTestsDir}/tests_SharedPacket.cpp
 )
 
 add_executable(${PROJECT_NAME} ${ProtocolTestsSources})
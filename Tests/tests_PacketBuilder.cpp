@@ -0,0 +1,154 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Packet builder unit tests
+ */
+
+#include <gtest/gtest.h>
+
+#include <Protocol/PacketBuilder.hpp>
+#include <Protocol/ConnectionProtocol.hpp>
+#include <Protocol/EventProtocol.hpp>
+
+using namespace Protocol;
+
+TEST(PacketBuilder, SimpleIntPacket)
+{
+    PacketChunkPool pool;
+    PacketBuilder builder(pool);
+    int x = 42;
+
+    // Serialize data
+    builder.prepare(ProtocolType::Connection, ConnectionCommand::IDAssignment);
+    ASSERT_EQ(builder.protocolType(), ProtocolType::Connection);
+    ASSERT_EQ(builder.commandAs<ConnectionCommand>(), ConnectionCommand::IDAssignment);
+    ASSERT_EQ(builder.payload(), 0u);
+    ASSERT_EQ(builder.footprintStackSize(), 0u);
+    builder << x;
+    ASSERT_EQ(builder.payload(), 4u);
+    ASSERT_EQ(builder.totalSize(), sizeof(PacketBuilder::Header) + sizeof(int));
+    ASSERT_EQ(builder.chunkCount(), 1u);
+
+    // Too small output buffer
+    char small[sizeof(PacketBuilder::Header)];
+    ASSERT_ANY_THROW(builder.finalize(std::begin(small), std::end(small)));
+
+    // Deserialize data
+    char buff[sizeof(PacketBuilder::Header) + sizeof(int)];
+    ASSERT_EQ(builder.finalize(std::begin(buff), std::end(buff)), sizeof(buff));
+    ReadablePacket rpacket(std::begin(buff), std::end(buff));
+    ASSERT_EQ(rpacket.magicKey(), SpecialLabMagicKey);
+    ASSERT_EQ(rpacket.protocolType(), ProtocolType::Connection);
+    ASSERT_EQ(rpacket.commandAs<ConnectionCommand>(), ConnectionCommand::IDAssignment);
+    ASSERT_EQ(rpacket.payload(), 4u);
+    ASSERT_EQ(rpacket.extract<int>(), x);
+}
+
+TEST(PacketBuilder, ControlsConnectionVector)
+{
+    constexpr std::size_t ControlCount = 500u;
+    constexpr std::size_t PayloadSize = sizeof(Payload) + ControlCount * sizeof(Control) + 2 * sizeof(BoardID);
+
+    PacketChunkPool pool;
+    PacketBuilder builder(pool);
+    std::vector<Control> input(ControlCount);
+
+    for (auto i = 0u; i < ControlCount; ++i)
+        input[i] = Control { Control::Type::Potentiometer, static_cast<std::uint8_t>(i), 1u, 2u };
+
+    // Serialize data, spanning many chunks
+    builder.prepare(ProtocolType::Event, EventCommand::ControlsConnection);
+    builder << input;
+    builder.pushFootprint(static_cast<BoardID>(42));
+    builder.pushFootprint(static_cast<BoardID>(84));
+    ASSERT_EQ(builder.payload(), PayloadSize);
+    ASSERT_EQ(builder.footprintStackSize(), 2u);
+    const auto chunkCount = builder.chunkCount();
+    ASSERT_EQ(chunkCount, (builder.totalSize() + PacketChunkPool::ChunkCapacity - 1) / PacketChunkPool::ChunkCapacity);
+
+    // Segments must cover the whole packet
+    std::vector<PacketBuilder::Segment> segments;
+    builder.finalizeSegments(std::back_inserter(segments));
+    ASSERT_EQ(segments.size(), chunkCount);
+    std::vector<std::uint8_t> gathered;
+    for (const auto &segment : segments)
+        gathered.insert(gathered.end(), segment.data, segment.data + segment.size);
+    ASSERT_EQ(gathered.size(), builder.totalSize());
+
+    // Contiguous output must match the gathered segments
+    std::vector<std::uint8_t> buff(builder.totalSize());
+    builder.finalize(buff.data(), buff.data() + buff.size());
+    ASSERT_EQ(buff, gathered);
+
+    // Deserialize data
+    ReadablePacket rpacket(buff.data(), buff.data() + buff.size());
+    ASSERT_EQ(rpacket.protocolType(), ProtocolType::Event);
+    ASSERT_EQ(rpacket.commandAs<EventCommand>(), EventCommand::ControlsConnection);
+    ASSERT_EQ(rpacket.payload(), PayloadSize);
+    ASSERT_EQ(rpacket.footprintStackSize(), 2u);
+    const auto output = rpacket.extract<std::vector<Control>>();
+    ASSERT_EQ(output.size(), ControlCount);
+    for (auto i = 0u; i < ControlCount; ++i) {
+        ASSERT_EQ(output[i].type, input[i].type);
+        ASSERT_EQ(output[i].value1, input[i].value1);
+        ASSERT_EQ(output[i].value2, input[i].value2);
+        ASSERT_EQ(output[i].value3, input[i].value3);
+    }
+    ASSERT_EQ(rpacket.footprintStackBegin()[0], 42);
+    ASSERT_EQ(rpacket.footprintStackBegin()[1], 84);
+
+    // Chunks are recycled on prepare and clear
+    builder.prepare(ProtocolType::Event, EventCommand::ControlsChanged);
+    ASSERT_EQ(builder.chunkCount(), 1u);
+    ASSERT_EQ(pool.freeCount(), chunkCount - 1);
+    builder.clear();
+    ASSERT_EQ(pool.freeCount(), chunkCount);
+}
+
+TEST(PacketBuilder, Overflow)
+{
+    PacketChunkPool pool;
+    PacketBuilder builder(pool);
+    std::vector<std::uint8_t> input(PacketBuilder::PayloadMax - sizeof(Payload));
+
+    // Not prepared
+    ASSERT_ANY_THROW(builder << 42);
+
+    builder.prepare(ProtocolType::Connection, ConnectionCommand::HardwareSpecs);
+    builder << input;
+    ASSERT_EQ(builder.payload(), PacketBuilder::PayloadMax);
+    ASSERT_EQ(builder.totalSize(), Internal::PacketBase::PayloadMax);
+    ASSERT_ANY_THROW(builder.pushFootprint(0u));
+    ASSERT_EQ(builder.payload(), PacketBuilder::PayloadMax);
+
+    // A maximum size packet is still representable by the other packet types
+    std::vector<std::uint8_t> buff(builder.totalSize());
+    builder.finalize(buff.data(), buff.data() + buff.size());
+    ReadablePacket rpacket(buff.data(), buff.data() + buff.size());
+    ASSERT_EQ(rpacket.totalSize(), buff.size());
+    ASSERT_EQ(rpacket.extract<std::vector<std::uint8_t>>().size(), input.size());
+}
+
+TEST(PacketBuilder, BulkInsert)
+{
+    static_assert(Internal::IsTriviallyBulkCopyable<const int *>);
+    static_assert(Internal::IsTriviallyBulkCopyable<std::vector<Control>::const_iterator>);
+    static_assert(Internal::IsTriviallyBulkCopyable<std::string::const_iterator>);
+    static_assert(!Internal::IsTriviallyBulkCopyable<std::vector<std::string>::const_iterator>);
+    static_assert(!Internal::IsTriviallyBulkCopyable<std::vector<bool>::const_iterator>);
+
+    PacketChunkPool pool;
+    PacketBuilder builder(pool);
+    const std::vector<Control> empty;
+    const std::string string(PacketChunkPool::ChunkCapacity * 2, 'x');
+
+    builder.prepare(ProtocolType::Event, EventCommand::ControlsConnection);
+    builder << empty << string;
+    ASSERT_EQ(builder.payload(), 2 * sizeof(Payload) + string.size());
+    ASSERT_EQ(builder.chunkCount(), 3u);
+
+    std::vector<std::uint8_t> buff(builder.totalSize());
+    builder.finalize(buff.data(), buff.data() + buff.size());
+    ReadablePacket rpacket(buff.data(), buff.data() + buff.size());
+    ASSERT_TRUE(rpacket.extract<std::vector<Control>>().empty());
+    ASSERT_EQ(rpacket.extract<std::string>(), string);
+}
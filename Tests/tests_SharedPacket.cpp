@@ -0,0 +1,198 @@
+/**
+ * @ Author: Matthieu Moinvaziri
+ * @ Description: Shared packet unit tests
+ */
+
+#include <gtest/gtest.h>
+
+#include <Protocol/SharedPacket.hpp>
+#include <Protocol/ConnectionProtocol.hpp>
+#include <Protocol/EventProtocol.hpp>
+
+using namespace Protocol;
+
+TEST(SharedPacket, FanOut)
+{
+    constexpr std::size_t DestinationCount = 4u;
+
+    PacketChunkPool pool;
+    PacketBuilder builder(pool);
+    std::vector<InputEvent> input(300u);
+
+    for (auto i = 0u; i < input.size(); ++i)
+        input[i] = InputEvent { static_cast<std::uint8_t>(i), static_cast<std::uint8_t>(i * 2) };
+    builder.prepare(ProtocolType::Event, EventCommand::ControlsChanged);
+    builder << input;
+    builder.pushFootprint(static_cast<BoardID>(1));
+
+    SharedPacketBuffer buffer(builder);
+    ASSERT_EQ(buffer.useCount(), 1u);
+    ASSERT_EQ(buffer.bodySize(), builder.payload() - 1u);
+
+    // Local consumers read the original packet without copy
+    auto view = buffer.view();
+    ASSERT_EQ(view.commandAs<EventCommand>(), EventCommand::ControlsChanged);
+    ASSERT_EQ(view.footprintStackSize(), 1u);
+    ASSERT_EQ(view.extract<std::vector<InputEvent>>().size(), input.size());
+
+    // Each destination overlays its own footprint stack
+    // Segments point into the handles, they must not move while queued
+    std::vector<SharedPacket> destinations;
+    destinations.reserve(DestinationCount);
+    for (auto i = 0u; i < DestinationCount; ++i) {
+        destinations.emplace_back(buffer);
+        destinations.back().pushFootprint(static_cast<BoardID>(10 + i));
+    }
+    ASSERT_EQ(buffer.useCount(), 1u + DestinationCount);
+
+    for (auto i = 0u; i < DestinationCount; ++i) {
+        const auto &packet = destinations[i];
+        ASSERT_EQ(packet.data(), destinations[0].data());
+        ASSERT_EQ(packet.footprintStackSize(), 2u);
+        ASSERT_EQ(packet.payload(), buffer.header().payload + 1u);
+
+        std::vector<PacketSegment> segments;
+        packet.segments(std::back_inserter(segments));
+        ASSERT_EQ(segments.size(), 3u);
+        ASSERT_EQ(segments[1].data, buffer.rawDataBegin() + sizeof(SharedPacket::Header));
+        std::size_t segmentsSize = 0u;
+        for (const auto &segment : segments)
+            segmentsSize += segment.size;
+        ASSERT_EQ(segmentsSize, packet.totalSize());
+
+        std::vector<std::uint8_t> buff(packet.totalSize());
+        ASSERT_EQ(packet.finalize(buff.data(), buff.data() + buff.size()), buff.size());
+        ReadablePacket rpacket(buff.data(), buff.data() + buff.size());
+        ASSERT_EQ(rpacket.commandAs<EventCommand>(), EventCommand::ControlsChanged);
+        ASSERT_EQ(rpacket.footprintStackSize(), 2u);
+        ASSERT_EQ(rpacket.footprintStackBegin()[0], 1u);
+        ASSERT_EQ(rpacket.footprintStackBegin()[1], 10u + i);
+        const auto output = rpacket.extract<std::vector<InputEvent>>();
+        ASSERT_EQ(output.size(), input.size());
+        for (auto j = 0u; j < input.size(); ++j) {
+            ASSERT_EQ(output[j].inputIdx, input[j].inputIdx);
+            ASSERT_EQ(output[j].value, input[j].value);
+        }
+    }
+
+    // The shared data outlives the original handle
+    destinations.erase(destinations.begin());
+    ASSERT_EQ(buffer.useCount(), DestinationCount);
+    { SharedPacketBuffer released(std::move(buffer)); }
+    ASSERT_EQ(destinations[0].buffer().useCount(), DestinationCount - 1u);
+    ASSERT_EQ(*destinations[0].data<Payload>(), input.size());
+
+    // A moved-from buffer can't be fanned out
+    ASSERT_EQ(buffer.useCount(), 0u);
+    ASSERT_ANY_THROW(SharedPacket { buffer });
+}
+
+TEST(SharedPacket, FootprintStack)
+{
+    char buff[sizeof(WritablePacket::Header) + sizeof(int) + 2 * sizeof(BoardID)];
+    int x = 42;
+
+    WritablePacket wpacket(std::begin(buff), std::end(buff));
+    wpacket.prepare(ProtocolType::Connection, ConnectionCommand::IDAssignment);
+    wpacket << x;
+    wpacket.pushFootprint(static_cast<BoardID>(42));
+    wpacket.pushFootprint(static_cast<BoardID>(84));
+
+    // Invalid raw data
+    ASSERT_ANY_THROW(SharedPacketBuffer(std::begin(buff), std::begin(buff) + 4));
+    ASSERT_ANY_THROW(SharedPacketBuffer(std::begin(buff), std::end(buff) - 1));
+
+    SharedPacketBuffer buffer(wpacket.rawDataBegin(), wpacket.rawDataEnd());
+    ASSERT_EQ(buffer.bodySize(), sizeof(int));
+
+    SharedPacket packet(buffer);
+    ASSERT_EQ(packet.payload(), 6u);
+    ASSERT_EQ(packet.footprintStackSize(), 2u);
+    ASSERT_EQ(*packet.data<int>(), x);
+    ASSERT_EQ(packet.popFrontStack(), 42);
+    ASSERT_EQ(packet.payload(), 5u);
+    ASSERT_EQ(packet.footprintStackSize(), 1u);
+    ASSERT_EQ(packet.popBackStack(), 84);
+    ASSERT_EQ(packet.payload(), 4u);
+    ASSERT_EQ(packet.footprintStackSize(), 0u);
+    ASSERT_EQ(packet.popBackStack(), 0u);
+
+    // Per-destination changes never touch the shared data
+    for (auto i = 0u; i < SharedPacket::InlineFootprintCapacity; ++i)
+        packet.pushFootprint(static_cast<BoardID>(i));
+    ASSERT_EQ(buffer.header().footprintStackSize, 2u);
+    ASSERT_EQ(SharedPacket(buffer).footprintStackBegin()[1], 84);
+}
+
+TEST(SharedPacket, DeepFootprintStack)
+{
+    constexpr std::size_t Depth = 40u;
+
+    PacketChunkPool pool;
+    PacketBuilder builder(pool);
+    builder.prepare(ProtocolType::Event, EventCommand::ControlsChanged);
+    builder << 42;
+    for (auto i = 0u; i < Depth; ++i)
+        builder.pushFootprint(static_cast<BoardID>(i));
+
+    // Stacks deeper than the inline overlay fall back to the heap
+    SharedPacketBuffer buffer(builder);
+    SharedPacket packet(buffer);
+    ASSERT_EQ(packet.footprintStackSize(), Depth);
+    ASSERT_EQ(packet.payload(), sizeof(int) + Depth);
+    for (auto i = 0u; i < Depth; ++i)
+        ASSERT_EQ(packet.footprintStackBegin()[i], i);
+    packet.pushFootprint(static_cast<BoardID>(Depth));
+    ASSERT_EQ(packet.popFrontStack(), 0u);
+    ASSERT_EQ(packet.footprintStackSize(), Depth);
+
+    // Copies own their stack, moves steal it
+    SharedPacket copy(packet);
+    ASSERT_EQ(copy.popBackStack(), Depth);
+    ASSERT_EQ(packet.footprintStackEnd()[-1], Depth);
+    SharedPacket moved(std::move(packet));
+    ASSERT_EQ(moved.footprintStackSize(), Depth);
+    ASSERT_EQ(moved.footprintStackBegin()[0], 1u);
+    copy = moved;
+    ASSERT_EQ(copy.footprintStackSize(), Depth);
+    ASSERT_EQ(copy.footprintStackEnd()[-1], Depth);
+
+    // Shrinking back keeps the packet consistent
+    while (moved.footprintStackSize())
+        moved.popBackStack();
+    ASSERT_EQ(moved.payload(), sizeof(int));
+    std::vector<std::uint8_t> buff(moved.totalSize());
+    moved.finalize(buff.data(), buff.data() + buff.size());
+    ASSERT_EQ(ReadablePacket(buff.data(), buff.data() + buff.size()).extract<int>(), 42);
+}
+
+TEST(SharedPacket, PayloadOverflow)
+{
+    PacketChunkPool pool;
+    PacketBuilder builder(pool);
+    std::vector<std::uint8_t> input(PacketBuilder::PayloadMax - sizeof(Payload));
+
+    builder.prepare(ProtocolType::Connection, ConnectionCommand::HardwareSpecs);
+    builder << input;
+
+    SharedPacketBuffer buffer(builder);
+    SharedPacket packet(buffer);
+    ASSERT_EQ(packet.payload(), PacketBuilder::PayloadMax);
+    ASSERT_ANY_THROW(packet.pushFootprint(7u));
+    ASSERT_EQ(packet.payload(), PacketBuilder::PayloadMax);
+    ASSERT_EQ(packet.footprintStackSize(), 0u);
+    ASSERT_EQ(packet.totalSize(), Internal::PacketBase::PayloadMax);
+}
+
+TEST(SharedPacket, OversizedRawHeader)
+{
+    constexpr std::size_t PayloadSize = PacketBuilder::PayloadMax + 7u;
+
+    std::vector<std::uint8_t> buff(sizeof(SharedPacket::Header) + PayloadSize);
+    SharedPacket::Header header;
+    header.payload = static_cast<Payload>(PayloadSize);
+    std::memcpy(buff.data(), &header, sizeof(header));
+
+    // A payload past the builder limit can't be represented by a Payload total size
+    ASSERT_ANY_THROW(SharedPacketBuffer(buff.data(), buff.data() + buff.size()));
+}